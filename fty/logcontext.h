@@ -0,0 +1,183 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <fmt/format.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace fty {
+
+// =====================================================================================================================
+
+/// Diagnostic context attached to every log record of the current thread.
+///
+///     fty::LogContext asset{"asset", id};
+///     fty::LogContext job{"job", jobNum};
+///     logInfo("Updated"); // "Updated asset=rackcontroller-0 job=42" with fty::ContextLayout
+///
+/// Fields live on a fixed-capacity thread-local stack and are popped when the LogContext goes out of scope.
+/// Strings are stored by reference: the referenced value must outlive the context, and the same applies to the
+/// snapshots taken while it is active. Field names are expected to be string literals.
+///
+/// Contexts are carried to another thread, e.g. to a thread-pool task, by a snapshot:
+///
+///     pool.post([ctx = fty::LogContext::snapshot()]() {
+///         fty::LogContext::Scope scope(ctx);
+///         ...
+///     });
+class LogContext
+{
+public:
+    static constexpr size_t Capacity = 16;
+
+    using Value = std::variant<std::string_view, int64_t, uint64_t, double, bool>;
+
+    struct Field
+    {
+        const char* name;
+        Value       value;
+    };
+
+    /// View of the fields, outermost first. Valid until the context stack of the thread changes.
+    class Fields
+    {
+    public:
+        Fields(const Field* begin = nullptr, const Field* end = nullptr)
+            : m_begin(begin)
+            , m_end(end)
+        {
+        }
+
+        const Field* begin() const
+        {
+            return m_begin;
+        }
+
+        const Field* end() const
+        {
+            return m_end;
+        }
+
+        size_t size() const
+        {
+            return size_t(m_end - m_begin);
+        }
+
+        bool empty() const
+        {
+            return m_begin == m_end;
+        }
+
+    private:
+        const Field* m_begin;
+        const Field* m_end;
+    };
+
+    /// Copy of the context stack, fields still reference the original values
+    class Snapshot
+    {
+    public:
+        Fields fields() const
+        {
+            return {m_fields.data(), m_fields.data() + m_size};
+        }
+
+    private:
+        friend class LogContext;
+        std::array<Field, Capacity> m_fields;
+        size_t                      m_size = 0;
+    };
+
+    /// Replaces the context of the current thread by a snapshot for its lifetime
+    class Scope
+    {
+    public:
+        Scope(const Snapshot& snapshot);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Snapshot m_saved;
+    };
+
+public:
+    template <typename T>
+    LogContext(const char* name, const T& value);
+
+    // Would reference a temporary
+    LogContext(const char* name, std::string&& value) = delete;
+
+    ~LogContext();
+
+    LogContext(const LogContext&) = delete;
+    LogContext(LogContext&&)      = delete;
+    LogContext& operator=(const LogContext&) = delete;
+    LogContext& operator=(LogContext&&) = delete;
+
+public:
+    /// Fields of the current thread
+    static Fields current();
+
+    /// Cheap copy of the current thread fields, to be restored by Scope
+    static Snapshot snapshot();
+
+private:
+    template <typename T>
+    static Value toValue(const T& value);
+
+    /// Returns false if the stack is full, the field is then ignored
+    static bool push(const char* name, Value&& value);
+    static void pop();
+
+private:
+    bool m_pushed;
+};
+
+// =====================================================================================================================
+
+template <typename T>
+LogContext::LogContext(const char* name, const T& value)
+    : m_pushed(push(name, toValue(value)))
+{
+}
+
+template <typename T>
+LogContext::Value LogContext::toValue(const T& value)
+{
+    if constexpr (std::is_same_v<T, bool>) {
+        return value;
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        return int64_t(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        return uint64_t(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return double(value);
+    } else if constexpr (std::is_enum_v<T>) {
+        return int64_t(value);
+    } else {
+        static_assert(std::is_convertible_v<const T&, std::string_view>, "Unsupported context value type");
+        return std::string_view(value);
+    }
+}
+
+} // namespace fty
+
+// =====================================================================================================================
+
+template <>
+struct fmt::formatter<fty::LogContext::Field> : fmt::formatter<std::string_view>
+{
+    template <typename FormatCtx>
+    auto format(const fty::LogContext::Field& field, FormatCtx& ctx) const
+    {
+        return std::visit(
+            [&](const auto& val) {
+                return fmt::format_to(ctx.out(), "{}={}", field.name, val);
+            },
+            field.value);
+    }
+};
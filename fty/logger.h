@@ -1,5 +1,6 @@
 #pragma once
 #include "fty/convert.h"
+#include "fty/logcontext.h"
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -0,0 +1,55 @@
+#pragma once
+#include "fty/logger.h"
+#include <chrono>
+#include <fty/expected.h>
+#include <string_view>
+
+namespace fty {
+
+// =====================================================================================================================
+
+/// Reader of segments written by `fty::CompressedAppender`.
+/// Uses the block index to inflate only the blocks which could match a query.
+class LogSegment
+{
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    struct Record
+    {
+        TimePoint        time;
+        Logger::Level    level;
+        std::string_view text; // Formatted by the appender layout, valid only during the callback
+    };
+
+    struct Query
+    {
+        TimePoint     from     = TimePoint::min();
+        TimePoint     to       = TimePoint::max();
+        Logger::Level minLevel = Logger::Level::Trace; // Least severe level to report
+    };
+
+    using Callback = std::function<void(const Record& record)>;
+
+public:
+    static Expected<LogSegment> open(const std::string& path);
+
+    LogSegment(LogSegment&&);
+    LogSegment& operator=(LogSegment&&);
+    ~LogSegment();
+
+    /// Number of blocks in the segment
+    size_t blocksCount() const;
+
+    /// Calls `callback` for every record matching the query, in the order they were written.
+    /// Returns the number of blocks which had to be decompressed.
+    Expected<size_t> query(const Query& query, const Callback& callback) const;
+
+private:
+    class Impl;
+    LogSegment(std::unique_ptr<Impl>&& impl);
+
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace fty
@@ -0,0 +1,331 @@
+#include "compressed-appender.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <unistd.h>
+
+namespace fty {
+
+// =====================================================================================================================
+
+static Logger::Level levelFromLog4cplus(log4cplus::LogLevel level)
+{
+    if (level >= log4cplus::FATAL_LOG_LEVEL) {
+        return Logger::Level::Fatal;
+    } else if (level >= log4cplus::ERROR_LOG_LEVEL) {
+        return Logger::Level::Error;
+    } else if (level >= log4cplus::WARN_LOG_LEVEL) {
+        return Logger::Level::Warn;
+    } else if (level >= log4cplus::INFO_LOG_LEVEL) {
+        return Logger::Level::Info;
+    } else if (level >= log4cplus::DEBUG_LOG_LEVEL) {
+        return Logger::Level::Debug;
+    }
+    return Logger::Level::Trace;
+}
+
+static size_t sizeFromString(const std::string& str, size_t def)
+{
+    char* end  = nullptr;
+    auto  size = std::strtoul(str.c_str(), &end, 10);
+    if (end == str.c_str()) {
+        return def;
+    }
+    std::string suffix(end);
+    if (suffix == "KB") {
+        size *= 1024;
+    } else if (suffix == "MB") {
+        size *= 1024 * 1024;
+    }
+    return size;
+}
+
+template <typename T>
+static void put(std::string& buf, const T& val)
+{
+    buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+static void reportError(const std::string& msg)
+{
+    log4cplus::helpers::getLogLog().error(LOG4CPLUS_TEXT("CompressedAppender: " + msg));
+}
+
+// =====================================================================================================================
+
+CompressedAppender::CompressedAppender(const log4cplus::helpers::Properties& props)
+    : log4cplus::Appender(props)
+{
+    props.getString(m_fileName, LOG4CPLUS_TEXT("File"));
+
+    std::string codec;
+    if (props.getString(codec, LOG4CPLUS_TEXT("Compression")) && codec == "zstd") {
+        m_codec = segment::Codec::Zstd;
+    }
+    props.getInt(m_compressionLevel, LOG4CPLUS_TEXT("CompressionLevel"));
+
+    std::string size;
+    if (props.getString(size, LOG4CPLUS_TEXT("BlockSize"))) {
+        // Leaves room for the record which overflows the block, readers reject larger blocks as corrupted
+        m_blockSize = std::min<size_t>(sizeFromString(size, m_blockSize), segment::MaxRawSize / 2);
+    }
+    if (props.getString(size, LOG4CPLUS_TEXT("MaxPendingBlocks"))) {
+        m_maxPending = std::max<size_t>(1, sizeFromString(size, m_maxPending));
+    }
+    if (props.getString(size, LOG4CPLUS_TEXT("MaxFileSize"))) {
+        m_maxFileSize = sizeFromString(size, m_maxFileSize);
+    }
+    unsigned long interval = 0;
+    if (props.getULong(interval, LOG4CPLUS_TEXT("FlushInterval"))) {
+        m_flushInterval = std::chrono::milliseconds(interval);
+    }
+    props.getInt(m_maxBackupIndex, LOG4CPLUS_TEXT("MaxBackupIndex"));
+
+    m_current.data.reserve(m_blockSize);
+    if (openSegment()) {
+        m_thread = std::thread(&CompressedAppender::worker, this);
+    }
+}
+
+CompressedAppender::~CompressedAppender()
+{
+    destructorImpl();
+}
+
+bool CompressedAppender::openSegment()
+{
+    if (m_fileName.empty()) {
+        reportError("File is not set");
+        return false;
+    }
+
+    m_fd = ::open(m_fileName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        reportError(fmt::format("Cannot open {}: {}", m_fileName, strerror(errno)));
+        return false;
+    }
+
+    // Continue an existing segment: keep its blocks, the index is rewritten on close
+    auto index = segment::readIndex(m_fd);
+    if (!index) {
+        // Never overwrite something we do not understand, e.g. an old plain text log
+        reportError(fmt::format("Refusing to write to {}: {}", m_fileName, index.error()));
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_index  = std::move(index->entries);
+    m_offset = index->dataEnd;
+    if (ftruncate(m_fd, off_t(m_offset)) != 0) {
+        reportError(fmt::format("Cannot truncate {}: {}", m_fileName, strerror(errno)));
+    }
+    return true;
+}
+
+void CompressedAppender::close()
+{
+    log4cplus::thread::MutexGuard guard(access_mutex);
+    if (closed) {
+        return;
+    }
+
+    if (m_thread.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            queueBlock(lock);
+            m_stop = true;
+        }
+        m_wakeWorker.notify_one();
+        m_thread.join();
+    }
+
+    if (m_fd >= 0) {
+        writeIndex();
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    closed = true;
+}
+
+void CompressedAppender::append(const log4cplus::spi::InternalLoggingEvent& event)
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    // A single record must not take a block beyond segment::MaxRawSize
+    auto        text  = std::string_view(formatEvent(event)).substr(0, segment::MaxRawSize / 4);
+    auto        level = levelFromLog4cplus(event.getLogLevel());
+    int64_t     time  = std::chrono::duration_cast<std::chrono::microseconds>(
+        event.getTimestamp().time_since_epoch()).count();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_current.records) {
+        m_current.first   = time;
+        m_current.last    = time;
+        m_current.started = Clock::now();
+    }
+    m_current.first = std::min(m_current.first, time);
+    m_current.last  = std::max(m_current.last, time);
+    m_current.levels |= segment::levelBit(level);
+    ++m_current.records;
+
+    put(m_current.data, time);
+    put(m_current.data, uint8_t(level));
+    put(m_current.data, uint32_t(text.size()));
+    m_current.data.append(text);
+
+    if (m_current.data.size() >= m_blockSize || level == Logger::Level::Fatal) {
+        queueBlock(lock);
+    } else if (m_current.records == 1 && m_flushInterval.count()) {
+        // Worker has to start the flush timer
+        lock.unlock();
+        m_wakeWorker.notify_one();
+    }
+}
+
+void CompressedAppender::queueBlock(std::unique_lock<std::mutex>& lock)
+{
+    if (!m_current.records) {
+        return;
+    }
+
+    // Do not let the queue grow unbounded if the storage is slower than the logging
+    m_wakeWriter.wait(lock, [&]() {
+        return m_pending.size() < m_maxPending;
+    });
+    m_pending.push_back(std::move(m_current));
+    m_wakeWorker.notify_one();
+
+    m_current = {};
+    m_current.data.reserve(m_blockSize);
+}
+
+void CompressedAppender::worker()
+{
+    while (true) {
+        Block block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto                         flushDue = [&]() {
+                return m_flushInterval.count() && m_current.records &&
+                       Clock::now() >= m_current.started + m_flushInterval;
+            };
+
+            while (!m_stop && m_pending.empty() && !flushDue()) {
+                if (m_flushInterval.count() && m_current.records) {
+                    m_wakeWorker.wait_until(lock, m_current.started + m_flushInterval);
+                } else {
+                    m_wakeWorker.wait(lock);
+                }
+            }
+
+            if (!m_pending.empty()) {
+                block = std::move(m_pending.front());
+                m_pending.pop_front();
+            } else if (flushDue()) {
+                // Partially filled block is old enough, it must reach the storage
+                block     = std::move(m_current);
+                m_current = {};
+                m_current.data.reserve(m_blockSize);
+            } else {
+                return;
+            }
+        }
+        m_wakeWriter.notify_one();
+
+        writeBlock(block);
+        if (m_maxFileSize && m_offset >= m_maxFileSize) {
+            rotate();
+        }
+    }
+}
+
+void CompressedAppender::writeBlock(const Block& block)
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    auto compressed = segment::compress(m_codec, m_compressionLevel, block.data);
+    if (!compressed) {
+        reportError(compressed.error());
+        return;
+    }
+
+    segment::IndexEntry entry;
+    entry.offset                = m_offset;
+    entry.header.codec          = m_codec;
+    entry.header.levels         = block.levels;
+    entry.header.compressedSize = uint32_t(compressed->size());
+    entry.header.rawSize        = uint32_t(block.data.size());
+    entry.header.first          = block.first;
+    entry.header.last           = block.last;
+    entry.header.records        = block.records;
+
+    uint64_t dataOffset = m_offset + sizeof(segment::BlockHeader);
+    if (auto res = segment::writeAt(m_fd, &entry.header, sizeof(entry.header), m_offset); !res) {
+        reportError(res.error());
+        return;
+    }
+    if (auto res = segment::writeAt(m_fd, compressed->data(), compressed->size(), dataOffset); !res) {
+        reportError(res.error());
+        return;
+    }
+
+    m_offset = dataOffset + compressed->size();
+    m_index.push_back(entry);
+}
+
+void CompressedAppender::writeIndex()
+{
+    segment::Footer footer;
+    footer.indexOffset = m_offset;
+    footer.count       = uint32_t(m_index.size());
+
+    uint64_t footerOffset = m_offset + m_index.size() * sizeof(segment::IndexEntry);
+    if (auto res = segment::writeAt(m_fd, m_index.data(), m_index.size() * sizeof(segment::IndexEntry), m_offset);
+        !res) {
+        reportError(res.error());
+        return;
+    }
+    if (auto res = segment::writeAt(m_fd, &footer, sizeof(footer), footerOffset); !res) {
+        reportError(res.error());
+        return;
+    }
+    if (fdatasync(m_fd) != 0) {
+        reportError(fmt::format("Cannot sync {}: {}", m_fileName, strerror(errno)));
+    }
+}
+
+void CompressedAppender::rotate()
+{
+    // Same scheme as log4cplus::RollingFileAppender: File -> File.1 -> ... -> File.MaxBackupIndex
+    writeIndex();
+    ::close(m_fd);
+    m_fd = -1;
+
+    if (m_maxBackupIndex > 0) {
+        std::remove(fmt::format("{}.{}", m_fileName, m_maxBackupIndex).c_str());
+        for (int i = m_maxBackupIndex - 1; i >= 1; --i) {
+            std::rename(fmt::format("{}.{}", m_fileName, i).c_str(), fmt::format("{}.{}", m_fileName, i + 1).c_str());
+        }
+        std::rename(m_fileName.c_str(), fmt::format("{}.1", m_fileName).c_str());
+    } else {
+        std::remove(m_fileName.c_str());
+    }
+
+    m_index.clear();
+    m_offset = 0;
+    openSegment();
+}
+
+} // namespace fty
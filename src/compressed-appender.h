@@ -0,0 +1,82 @@
+#pragma once
+#include "segment.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <log4cplus/appender.h>
+#include <mutex>
+#include <thread>
+
+namespace fty {
+
+// =====================================================================================================================
+
+/// Appender which writes logs as a segment of independently compressed blocks with a footer index, see segment.h.
+///
+/// Configuration properties:
+///   File             - path to the segment, an existing segment is continued
+///   Compression      - lz4 (default) or zstd
+///   CompressionLevel - codec specific level, acceleration for lz4
+///   BlockSize        - size of uncompressed block, accepts KB/MB suffixes (default 64KB, at most 32MB)
+///   MaxPendingBlocks - blocks waiting for compression before logging blocks (default 4)
+///   FlushInterval    - milliseconds before a partially filled block is written, 0 disables (default 5000)
+///   MaxFileSize      - segment size triggering rotation, accepts KB/MB suffixes, 0 disables (default 10MB)
+///   MaxBackupIndex   - rotated segments kept as File.1 ... File.N (default 1)
+///
+/// Compression and writing are done by a background thread. A partially filled block is also written on FATAL
+/// records and when the appender is closed.
+class CompressedAppender : public log4cplus::Appender
+{
+public:
+    CompressedAppender(const log4cplus::helpers::Properties& props);
+    ~CompressedAppender() override;
+
+    void close() override;
+
+protected:
+    void append(const log4cplus::spi::InternalLoggingEvent& event) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Block
+    {
+        std::string       data;
+        int64_t           first   = 0; // Earliest record, records of several threads are not in time order
+        int64_t           last    = 0; // Latest record
+        uint8_t           levels  = 0;
+        uint32_t          records = 0;
+        Clock::time_point started;
+    };
+
+    bool openSegment();
+    void queueBlock(std::unique_lock<std::mutex>& lock);
+    void worker();
+    void writeBlock(const Block& block);
+    void writeIndex();
+    void rotate();
+
+private:
+    std::string               m_fileName;
+    segment::Codec            m_codec            = segment::Codec::Lz4;
+    int                       m_compressionLevel = 0;
+    size_t                    m_blockSize        = 64 * 1024;
+    size_t                    m_maxPending       = 4;
+    std::chrono::milliseconds m_flushInterval    = std::chrono::milliseconds(5000);
+    uint64_t                  m_maxFileSize      = 10 * 1024 * 1024;
+    int                       m_maxBackupIndex   = 1;
+
+    int                              m_fd     = -1;
+    std::vector<segment::IndexEntry> m_index;      // Touched only by the worker thread once started
+    uint64_t                         m_offset = 0; // Where the next block goes
+
+    Block                   m_current; // Guarded by m_mutex, the worker flushes it after FlushInterval
+    std::deque<Block>       m_pending;
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeWorker;
+    std::condition_variable m_wakeWriter;
+    bool                    m_stop = false;
+    std::thread             m_thread;
+};
+
+} // namespace fty
@@ -0,0 +1,60 @@
+#include "context-layout.h"
+#include "fty/logcontext.h"
+#include <iterator>
+#include <log4cplus/helpers/property.h>
+
+namespace fty {
+
+// =====================================================================================================================
+
+ContextLayout::ContextLayout(const log4cplus::tstring& pattern)
+{
+    init(pattern);
+}
+
+ContextLayout::ContextLayout(const log4cplus::helpers::Properties& props)
+    : log4cplus::Layout(props)
+{
+    init(props.getProperty(LOG4CPLUS_TEXT("ConversionPattern")));
+}
+
+void ContextLayout::init(const log4cplus::tstring& pattern)
+{
+    log4cplus::tstring part;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] == '%' && i + 1 < pattern.size()) {
+            if (pattern[i + 1] == 'K') {
+                m_parts.emplace_back(std::make_unique<log4cplus::PatternLayout>(part));
+                part.clear();
+                ++i;
+                continue;
+            }
+            // Keep escapes and other specifiers untouched, "%%K" is a literal
+            part += pattern[i++];
+        }
+        part += pattern[i];
+    }
+    m_parts.emplace_back(std::make_unique<log4cplus::PatternLayout>(part));
+}
+
+void ContextLayout::formatAndAppend(log4cplus::tostream& output, const log4cplus::spi::InternalLoggingEvent& event)
+{
+    auto fields = LogContext::current();
+
+    for (size_t i = 0; i < m_parts.size(); ++i) {
+        if (i) {
+            // Only the fields are rendered here, the message itself is never copied
+            fmt::memory_buffer buf;
+            for (const auto& field : fields) {
+                if (buf.size()) {
+                    buf.push_back(' ');
+                }
+                fmt::format_to(std::back_inserter(buf), "{}", field);
+            }
+            output.write(buf.data(), std::streamsize(buf.size()));
+        }
+        m_parts[i]->formatAndAppend(output, event);
+    }
+}
+
+} // namespace fty
@@ -0,0 +1,31 @@
+#pragma once
+#include <log4cplus/layout.h>
+#include <memory>
+#include <vector>
+
+namespace fty {
+
+// =====================================================================================================================
+
+/// Pattern layout with an additional `%K` conversion specifier printing the fields of the thread LogContext, e.g.
+///   [%-5p][%d] %m %K%n  ->  [INFO ][2021/03/01 10:00:00:000] Updated asset=rackcontroller-0 job=42
+///
+/// log4cplus does not allow custom converters, so the pattern is split at every `%K` and the parts are formatted by
+/// plain pattern layouts; the fields are written straight to the output in between.
+/// Fields are read from the logging thread, so this layout must not be used behind an AsyncAppender.
+class ContextLayout : public log4cplus::Layout
+{
+public:
+    ContextLayout(const log4cplus::tstring& pattern);
+    ContextLayout(const log4cplus::helpers::Properties& props);
+
+    void formatAndAppend(log4cplus::tostream& output, const log4cplus::spi::InternalLoggingEvent& event) override;
+
+private:
+    void init(const log4cplus::tstring& pattern);
+
+private:
+    std::vector<std::unique_ptr<log4cplus::PatternLayout>> m_parts; // Fields go between two parts
+};
+
+} // namespace fty
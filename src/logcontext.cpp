@@ -0,0 +1,56 @@
+#include "fty/logcontext.h"
+
+namespace fty {
+
+// =====================================================================================================================
+
+// Context stack of the thread, a snapshot is simply a copy of it
+static thread_local LogContext::Snapshot t_stack;
+
+bool LogContext::push(const char* name, Value&& value)
+{
+    if (t_stack.m_size == Capacity) {
+        return false;
+    }
+    t_stack.m_fields[t_stack.m_size++] = {name, std::move(value)};
+    return true;
+}
+
+void LogContext::pop()
+{
+    if (t_stack.m_size) {
+        --t_stack.m_size;
+    }
+}
+
+LogContext::~LogContext()
+{
+    if (m_pushed) {
+        pop();
+    }
+}
+
+LogContext::Fields LogContext::current()
+{
+    return t_stack.fields();
+}
+
+LogContext::Snapshot LogContext::snapshot()
+{
+    return t_stack;
+}
+
+// =====================================================================================================================
+
+LogContext::Scope::Scope(const Snapshot& snapshot)
+    : m_saved(t_stack)
+{
+    t_stack = snapshot;
+}
+
+LogContext::Scope::~Scope()
+{
+    t_stack = m_saved;
+}
+
+} // namespace fty
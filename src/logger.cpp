@@ -1,9 +1,14 @@
 #include "fty/logger.h"
+#include "compressed-appender.h"
+#include "context-layout.h"
+#include "socket-appender.h"
 #include <fty/expected.h>
 #include <log4cplus/configurator.h>
 #include <log4cplus/consoleappender.h>
 #include <log4cplus/helpers/pointer.h>
 #include <log4cplus/logger.h>
+#include <log4cplus/spi/factory.h>
+#include <mutex>
 #include <unistd.h>
 
 namespace fty {
@@ -21,6 +26,7 @@ public:
     {
         // initialize log4cplus
         log4cplus::initialize();
+        registerAppenders();
 
         // Create logger
         m_logger = log4cplus::Logger::getInstance(LOG4CPLUS_TEXT(compName));
@@ -49,7 +55,7 @@ public:
             // Create console appender
             auto append = new log4cplus::ConsoleAppender(true, true);
             // Create and affect layout
-            append->setLayout(std::unique_ptr<log4cplus::Layout>(new log4cplus::PatternLayout(m_layoutPattern)));
+            append->setLayout(std::unique_ptr<log4cplus::Layout>(new ContextLayout(m_layoutPattern)));
             append->setName(LOG4CPLUS_TEXT("Console" + m_agentName));
 
             // Add appender to logger
@@ -60,6 +66,24 @@ public:
     }
 
 private:
+    // Makes our own appenders and layouts available to the configuration file
+    static void registerAppenders()
+    {
+        static std::once_flag once;
+        std::call_once(once, []() {
+            using Factory = log4cplus::spi::AppenderFactory;
+            auto& reg     = log4cplus::spi::getAppenderFactoryRegistry();
+            reg.put(std::make_unique<log4cplus::spi::FactoryTempl<CompressedAppender, Factory>>(
+                LOG4CPLUS_TEXT("fty::CompressedAppender")));
+            reg.put(std::make_unique<log4cplus::spi::FactoryTempl<UnixSocketAppender, Factory>>(
+                LOG4CPLUS_TEXT("fty::UnixSocketAppender")));
+
+            auto& layouts = log4cplus::spi::getLayoutFactoryRegistry();
+            layouts.put(std::make_unique<log4cplus::spi::FactoryTempl<ContextLayout, log4cplus::spi::LayoutFactory>>(
+                LOG4CPLUS_TEXT("fty::ContextLayout")));
+        });
+    }
+
     static std::optional<log4cplus::LogLevel> levelFromString(const std::string& level)
     {
         if (level == "LOG_TRACE") {
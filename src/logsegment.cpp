@@ -0,0 +1,154 @@
+#include "fty/logsegment.h"
+#include "segment.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <unistd.h>
+
+namespace fty {
+
+// =====================================================================================================================
+
+class LogSegment::Impl
+{
+public:
+    Impl(int fd, segment::Index&& index)
+        : m_fd(fd)
+        , m_index(std::move(index))
+    {
+    }
+
+    ~Impl()
+    {
+        ::close(m_fd);
+    }
+
+    size_t blocksCount() const
+    {
+        return m_index.entries.size();
+    }
+
+    Expected<size_t> query(const Query& query, const Callback& callback) const
+    {
+        using namespace std::chrono;
+
+        int64_t from = query.from == TimePoint::min()
+                           ? std::numeric_limits<int64_t>::min()
+                           : duration_cast<microseconds>(query.from.time_since_epoch()).count();
+        int64_t to   = query.to == TimePoint::max()
+                           ? std::numeric_limits<int64_t>::max()
+                           : duration_cast<microseconds>(query.to.time_since_epoch()).count();
+        uint8_t mask = segment::levelMask(query.minLevel);
+
+        size_t inflated = 0;
+        for (const auto& entry : m_index.entries) {
+            const auto& header = entry.header;
+            if (header.last < from || header.first > to || !(header.levels & mask)) {
+                continue;
+            }
+
+            std::string compressed(header.compressedSize, '\0');
+            if (auto res = segment::readAt(m_fd, compressed.data(), compressed.size(),
+                    entry.offset + sizeof(segment::BlockHeader));
+                !res) {
+                return unexpected(res.error());
+            }
+
+            auto raw = segment::decompress(header.codec, compressed, header.rawSize);
+            if (!raw) {
+                return unexpected("Block at {}: {}", entry.offset, raw.error());
+            }
+            ++inflated;
+
+            if (auto res = parseRecords(*raw, from, to, mask, callback); !res) {
+                return unexpected("Block at {}: {}", entry.offset, res.error());
+            }
+        }
+        return inflated;
+    }
+
+private:
+    template <typename T>
+    static T get(const std::string& buf, size_t& pos)
+    {
+        T val;
+        memcpy(&val, buf.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    static Expected<void> parseRecords(
+        const std::string& raw, int64_t from, int64_t to, uint8_t mask, const Callback& callback)
+    {
+        static constexpr size_t RecordHeaderSize = sizeof(int64_t) + sizeof(uint8_t) + sizeof(uint32_t);
+
+        size_t pos = 0;
+        while (pos < raw.size()) {
+            if (pos + RecordHeaderSize > raw.size()) {
+                return unexpected("truncated record");
+            }
+            auto time  = get<int64_t>(raw, pos);
+            auto level = get<uint8_t>(raw, pos);
+            auto size  = get<uint32_t>(raw, pos);
+            if (pos + size > raw.size()) {
+                return unexpected("truncated record");
+            }
+            if (level > uint8_t(Logger::Level::Trace)) {
+                return unexpected("invalid record level {}", int(level));
+            }
+
+            if (time >= from && time <= to && (segment::levelBit(Logger::Level(level)) & mask)) {
+                Record rec;
+                rec.time  = TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::microseconds(time)));
+                rec.level = Logger::Level(level);
+                rec.text  = std::string_view(raw.data() + pos, size);
+                callback(rec);
+            }
+            pos += size;
+        }
+        return {};
+    }
+
+private:
+    int            m_fd;
+    segment::Index m_index;
+};
+
+// =====================================================================================================================
+
+Expected<LogSegment> LogSegment::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return unexpected("Cannot open {}: {}", path, strerror(errno));
+    }
+
+    auto index = segment::readIndex(fd);
+    if (!index) {
+        ::close(fd);
+        return unexpected(index.error());
+    }
+    return LogSegment(std::make_unique<Impl>(fd, std::move(*index)));
+}
+
+LogSegment::LogSegment(std::unique_ptr<Impl>&& impl)
+    : m_impl(std::move(impl))
+{
+}
+
+LogSegment::LogSegment(LogSegment&&) = default;
+LogSegment& LogSegment::operator=(LogSegment&&) = default;
+LogSegment::~LogSegment()                       = default;
+
+size_t LogSegment::blocksCount() const
+{
+    return m_impl->blocksCount();
+}
+
+Expected<size_t> LogSegment::query(const Query& query, const Callback& callback) const
+{
+    return m_impl->query(query, callback);
+}
+
+} // namespace fty
@@ -0,0 +1,179 @@
+#include "segment.h"
+#include <cerrno>
+#include <cstring>
+#include <lz4.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zstd.h>
+
+namespace fty::segment {
+
+// =====================================================================================================================
+
+Expected<std::string> compress(Codec codec, int level, const std::string& raw)
+{
+    std::string out;
+    switch (codec) {
+    case Codec::Lz4: {
+        out.resize(size_t(LZ4_compressBound(int(raw.size()))));
+        int size = LZ4_compress_fast(raw.data(), out.data(), int(raw.size()), int(out.size()), level > 0 ? level : 1);
+        if (size <= 0) {
+            return unexpected("LZ4 compression failed");
+        }
+        out.resize(size_t(size));
+        return out;
+    }
+    case Codec::Zstd: {
+        out.resize(ZSTD_compressBound(raw.size()));
+        size_t size = ZSTD_compress(out.data(), out.size(), raw.data(), raw.size(), level);
+        if (ZSTD_isError(size)) {
+            return unexpected("ZSTD compression failed: {}", ZSTD_getErrorName(size));
+        }
+        out.resize(size);
+        return out;
+    }
+    }
+    return unexpected("Unknown codec {}", int(codec));
+}
+
+Expected<std::string> decompress(Codec codec, const std::string& data, uint32_t rawSize)
+{
+    std::string out(rawSize, '\0');
+    switch (codec) {
+    case Codec::Lz4: {
+        int size = LZ4_decompress_safe(data.data(), out.data(), int(data.size()), int(out.size()));
+        if (size < 0 || uint32_t(size) != rawSize) {
+            return unexpected("LZ4 block is corrupted");
+        }
+        return out;
+    }
+    case Codec::Zstd: {
+        size_t size = ZSTD_decompress(out.data(), out.size(), data.data(), data.size());
+        if (ZSTD_isError(size) || size != rawSize) {
+            return unexpected("ZSTD block is corrupted");
+        }
+        return out;
+    }
+    }
+    return unexpected("Unknown codec {}", int(codec));
+}
+
+// =====================================================================================================================
+
+Expected<void> readAt(int fd, void* buf, size_t size, uint64_t offset)
+{
+    auto ptr = static_cast<char*>(buf);
+    while (size) {
+        ssize_t rd = pread(fd, ptr, size, off_t(offset));
+        if (rd < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rd <= 0) {
+            return unexpected("Cannot read segment: {}", rd < 0 ? strerror(errno) : "unexpected end of file");
+        }
+        ptr += rd;
+        size -= size_t(rd);
+        offset += uint64_t(rd);
+    }
+    return {};
+}
+
+Expected<void> writeAt(int fd, const void* buf, size_t size, uint64_t offset)
+{
+    auto ptr = static_cast<const char*>(buf);
+    while (size) {
+        ssize_t wr = pwrite(fd, ptr, size, off_t(offset));
+        if (wr < 0 && errno == EINTR) {
+            continue;
+        }
+        if (wr < 0) {
+            return unexpected("Cannot write segment: {}", strerror(errno));
+        }
+        ptr += wr;
+        size -= size_t(wr);
+        offset += uint64_t(wr);
+    }
+    return {};
+}
+
+// =====================================================================================================================
+
+static bool isValid(const BlockHeader& header, uint64_t offset, uint64_t fileSize)
+{
+    return header.magic == BlockMagic && (header.codec == Codec::Lz4 || header.codec == Codec::Zstd) &&
+           header.rawSize <= MaxRawSize && offset + sizeof(BlockHeader) + header.compressedSize <= fileSize;
+}
+
+static Expected<Index> readFooterIndex(int fd, uint64_t fileSize)
+{
+    if (fileSize < sizeof(Footer)) {
+        return unexpected("No footer");
+    }
+
+    Footer footer;
+    if (auto res = readAt(fd, &footer, sizeof(footer), fileSize - sizeof(Footer)); !res) {
+        return unexpected(res.error());
+    }
+
+    if (footer.magic != FooterMagic ||
+        footer.indexOffset + uint64_t(footer.count) * sizeof(IndexEntry) + sizeof(Footer) != fileSize) {
+        return unexpected("Invalid footer");
+    }
+
+    Index index;
+    index.dataEnd = footer.indexOffset;
+    index.entries.resize(footer.count);
+    if (auto res = readAt(fd, index.entries.data(), index.entries.size() * sizeof(IndexEntry), footer.indexOffset);
+        !res) {
+        return unexpected(res.error());
+    }
+
+    for (const auto& entry : index.entries) {
+        if (!isValid(entry.header, entry.offset, index.dataEnd)) {
+            return unexpected("Invalid index entry at {}", entry.offset);
+        }
+    }
+    return index;
+}
+
+static Index scanBlocks(int fd, uint64_t fileSize)
+{
+    Index index;
+    while (index.dataEnd + sizeof(BlockHeader) <= fileSize) {
+        IndexEntry entry;
+        entry.offset = index.dataEnd;
+        if (!readAt(fd, &entry.header, sizeof(BlockHeader), entry.offset) ||
+            !isValid(entry.header, entry.offset, fileSize)) {
+            break;
+        }
+        index.entries.push_back(entry);
+        index.dataEnd += sizeof(BlockHeader) + entry.header.compressedSize;
+    }
+    return index;
+}
+
+Expected<Index> readIndex(int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return unexpected("Cannot stat segment: {}", strerror(errno));
+    }
+
+    uint64_t fileSize = uint64_t(st.st_size);
+    if (auto index = readFooterIndex(fd, fileSize)) {
+        return std::move(*index);
+    }
+
+    // Segment was not closed properly, recover what we can from the block headers
+    Index index = scanBlocks(fd, fileSize);
+    if (index.entries.empty() && fileSize) {
+        // Only a segment whose first block was never completed is still accepted
+        uint32_t magic = 0;
+        if (fileSize < sizeof(magic) || !readAt(fd, &magic, sizeof(magic), 0) || magic != BlockMagic) {
+            return unexpected("Not a log segment");
+        }
+    }
+    return index;
+}
+
+} // namespace fty::segment
@@ -0,0 +1,98 @@
+#pragma once
+#include "fty/logger.h"
+#include <cstdint>
+#include <fty/expected.h>
+#include <string>
+#include <vector>
+
+// On-disk layout of a compressed log segment, shared by the appender and the reader.
+//
+//   [BlockHeader][compressed records] ... [BlockHeader][compressed records] [IndexEntry]*N [Footer]
+//
+// Every block is compressed on its own, so a reader only needs to inflate the blocks selected by the index. The
+// block headers duplicate the index, so a segment which was not closed properly (no footer) can still be read by
+// walking the headers.
+//
+// Uncompressed block content is a sequence of records: [int64 time][uint8 level][uint32 size][size bytes of text].
+// All integers are stored in host byte order, segments are not meant to be moved between architectures.
+
+namespace fty::segment {
+
+// =====================================================================================================================
+
+enum class Codec : uint8_t
+{
+    Lz4  = 1,
+    Zstd = 2
+};
+
+static constexpr uint32_t BlockMagic  = 0x42595446; // "FTYB"
+static constexpr uint32_t FooterMagic = 0x49595446; // "FTYI"
+
+// Upper bound of an uncompressed block, a header claiming more is corrupted
+static constexpr uint32_t MaxRawSize = 64 * 1024 * 1024;
+
+struct BlockHeader
+{
+    uint32_t magic          = BlockMagic;
+    Codec    codec          = Codec::Lz4;
+    uint8_t  levels         = 0; // Bitmap of levels present in the block, bit N is set for Logger::Level(N)
+    uint16_t reserved       = 0;
+    uint32_t compressedSize = 0;
+    uint32_t rawSize        = 0;
+    int64_t  first          = 0; // Earliest record timestamp, microseconds since epoch
+    int64_t  last           = 0; // Latest record timestamp, microseconds since epoch
+    uint32_t records        = 0;
+    uint32_t reserved2      = 0;
+};
+static_assert(sizeof(BlockHeader) == 40);
+
+struct IndexEntry
+{
+    uint64_t    offset = 0; // Offset of the block header in the segment
+    BlockHeader header;
+};
+static_assert(sizeof(IndexEntry) == 48);
+
+struct Footer
+{
+    uint64_t indexOffset = 0;
+    uint32_t count       = 0;
+    uint32_t magic       = FooterMagic;
+};
+static_assert(sizeof(Footer) == 16);
+
+struct Index
+{
+    std::vector<IndexEntry> entries;
+    uint64_t                dataEnd = 0; // End of the last valid block, new blocks are appended from here
+};
+
+// =====================================================================================================================
+
+inline uint8_t levelBit(Logger::Level level)
+{
+    return uint8_t(1u << static_cast<unsigned>(level));
+}
+
+/// Mask of all levels at least as severe as `minLevel`
+inline uint8_t levelMask(Logger::Level minLevel)
+{
+    uint8_t mask = 0;
+    for (unsigned lvl = unsigned(Logger::Level::Fatal); lvl <= unsigned(minLevel); ++lvl) {
+        mask |= uint8_t(1u << lvl);
+    }
+    return mask;
+}
+
+Expected<std::string> compress(Codec codec, int level, const std::string& raw);
+Expected<std::string> decompress(Codec codec, const std::string& data, uint32_t rawSize);
+
+/// Reads the footer index of the opened segment, falls back to walking block headers if the footer is missing.
+/// Fails if a non empty file is not recognised as a segment.
+Expected<Index> readIndex(int fd);
+
+Expected<void> readAt(int fd, void* buf, size_t size, uint64_t offset);
+Expected<void> writeAt(int fd, const void* buf, size_t size, uint64_t offset);
+
+} // namespace fty::segment
@@ -0,0 +1,309 @@
+#include "socket-appender.h"
+#include <cerrno>
+#include <cstring>
+#include <fmt/format.h>
+#include <log4cplus/helpers/loglog.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <log4cplus/thread/syncprims-pub-impl.h>
+#include <optional>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fty {
+
+// =====================================================================================================================
+
+static constexpr auto ReportInterval = std::chrono::seconds(10);
+
+static void reportError(const std::string& msg)
+{
+    log4cplus::helpers::getLogLog().error(LOG4CPLUS_TEXT("UnixSocketAppender: " + msg));
+}
+
+// =====================================================================================================================
+
+UnixSocketAppender::UnixSocketAppender(const log4cplus::helpers::Properties& props)
+    : log4cplus::Appender(props)
+{
+    props.getString(m_path, LOG4CPLUS_TEXT("Path"));
+
+    unsigned long val = 0;
+    if (props.getULong(val, LOG4CPLUS_TEXT("BatchSize")) && val) {
+        m_batchSize = val;
+    }
+    if (props.getULong(val, LOG4CPLUS_TEXT("MaxLatency"))) {
+        m_maxLatency = std::chrono::milliseconds(val);
+    }
+    if (props.getULong(val, LOG4CPLUS_TEXT("QueueSize")) && val) {
+        m_queueSize = val;
+    }
+    if (props.getULong(val, LOG4CPLUS_TEXT("ReconnectDelay"))) {
+        m_reconnectDelay = std::chrono::milliseconds(val);
+    }
+    if (props.getULong(val, LOG4CPLUS_TEXT("FlushTimeout"))) {
+        m_flushTimeout = std::chrono::milliseconds(val);
+    }
+    m_dropOnOverflow = props.getProperty(LOG4CPLUS_TEXT("Overflow"), LOG4CPLUS_TEXT("drop")) != "block";
+
+    if (m_path.empty() || m_path.size() >= sizeof(sockaddr_un::sun_path)) {
+        reportError(fmt::format("Invalid socket path '{}'", m_path));
+        return;
+    }
+
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        reportError(fmt::format("Cannot create eventfd: {}", strerror(errno)));
+        return;
+    }
+
+    m_msgs.resize(m_batchSize);
+    m_iovs.resize(m_batchSize);
+    m_thread = std::thread(&UnixSocketAppender::worker, this);
+}
+
+UnixSocketAppender::~UnixSocketAppender()
+{
+    destructorImpl();
+}
+
+void UnixSocketAppender::close()
+{
+    // Stop first: log4cplus calls append() with access_mutex held, and a writer blocked on a full queue only
+    // leaves it once it sees m_stop
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeWorker.notify_one();
+    m_wakeWriter.notify_all();
+    if (m_wakeFd >= 0) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto res = ::write(m_wakeFd, &one, sizeof(one));
+    }
+
+    log4cplus::thread::MutexGuard guard(access_mutex);
+    if (closed) {
+        return;
+    }
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    disconnect();
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    closed = true;
+}
+
+UnixSocketAppender::Stats UnixSocketAppender::stats() const
+{
+    Stats st;
+    st.sent    = m_sent;
+    st.dropped = m_dropped;
+    st.batches = m_batches;
+    return st;
+}
+
+void UnixSocketAppender::append(const log4cplus::spi::InternalLoggingEvent& event)
+{
+    if (!m_thread.joinable()) {
+        ++m_dropped;
+        return;
+    }
+
+    const auto& text = formatEvent(event);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_queue.size() >= m_queueSize && !m_dropOnOverflow) {
+        m_wakeWriter.wait(lock, [&]() {
+            return m_stop || m_queue.size() < m_queueSize;
+        });
+    }
+    if (m_stop || m_queue.size() >= m_queueSize) {
+        ++m_dropped;
+        return;
+    }
+
+    m_queue.push_back({text, Clock::now()});
+    // Worker has to know about the first record to start the latency timer, then only about a full batch
+    bool wake = m_queue.size() == 1 || m_queue.size() == m_batchSize;
+    lock.unlock();
+
+    if (wake) {
+        m_wakeWorker.notify_one();
+    }
+}
+
+// =====================================================================================================================
+
+void UnixSocketAppender::worker()
+{
+    std::vector<Record>              batch;
+    std::optional<Clock::time_point> flushDeadline;
+    batch.reserve(m_batchSize);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto                         ready = [&]() {
+                return m_stop || batch.size() + m_queue.size() >= m_batchSize;
+            };
+
+            if (batch.empty() && m_queue.empty()) {
+                m_wakeWorker.wait(lock, [&]() {
+                    return m_stop || !m_queue.empty();
+                });
+            }
+            if (!ready()) {
+                auto oldest = batch.empty() ? m_queue.front().queued : batch.front().queued;
+                m_wakeWorker.wait_until(lock, oldest + m_maxLatency, ready);
+            }
+
+            while (batch.size() < m_batchSize && !m_queue.empty()) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+
+            if (m_stop && !flushDeadline) {
+                // Keep sending what is queued for a while, without waiting for the reconnect delay
+                flushDeadline = Clock::now() + m_flushTimeout;
+                m_reconnectAt = {};
+            }
+            if (m_stop && batch.empty()) {
+                break;
+            }
+        }
+        m_wakeWriter.notify_all();
+
+        if (!send(batch)) {
+            if (flushDeadline && Clock::now() >= *flushDeadline) {
+                // Collector did not take the rest in time, account for everything which did not make it
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_dropped += batch.size() + m_queue.size();
+                m_queue.clear();
+                break;
+            }
+            waitCollector(flushDeadline.value_or(Clock::time_point::max()), bool(flushDeadline));
+        }
+        reportDrops(false);
+    }
+    reportDrops(true);
+}
+
+bool UnixSocketAppender::send(std::vector<Record>& batch)
+{
+    if (m_fd < 0 && !connect()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        m_iovs[i].iov_base = batch[i].text.data();
+        m_iovs[i].iov_len  = batch[i].text.size();
+
+        m_msgs[i]                    = {};
+        m_msgs[i].msg_hdr.msg_iov    = &m_iovs[i];
+        m_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = sendmmsg(m_fd, m_msgs.data(), unsigned(batch.size()), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent < 0) {
+        switch (errno) {
+        case EAGAIN:
+        case EINTR:
+        case ENOBUFS:
+            return false;
+        case EMSGSIZE:
+            // Collector will never accept this one, do not let it block the rest
+            ++m_dropped;
+            batch.erase(batch.begin());
+            return true;
+        default:
+            reportError(fmt::format("Cannot send to {}: {}", m_path, strerror(errno)));
+            disconnect();
+            return false;
+        }
+    }
+
+    m_sent += uint64_t(sent);
+    ++m_batches;
+    batch.erase(batch.begin(), batch.begin() + sent);
+    return true;
+}
+
+bool UnixSocketAppender::connect()
+{
+    if (Clock::now() < m_reconnectAt) {
+        return false;
+    }
+    m_reconnectAt = Clock::now() + m_reconnectDelay;
+
+    m_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        reportError(fmt::format("Cannot create socket: {}", strerror(errno)));
+        return false;
+    }
+
+    sockaddr_un addr = {};
+    addr.sun_family  = AF_UNIX;
+    strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // Connecting a datagram socket does not wait for the peer, it fails immediately if nobody listens
+    if (::connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+void UnixSocketAppender::disconnect()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void UnixSocketAppender::waitCollector(Clock::time_point until, bool stopping)
+{
+    if (m_fd >= 0) {
+        // Collector is alive but its buffer is full
+        until        = std::min(until, Clock::now() + m_maxLatency);
+        auto timeout = std::chrono::ceil<std::chrono::milliseconds>(until - Clock::now());
+
+        // Once stopping, the wake up event stays signaled and only the collector matters
+        pollfd pfds[] = {{m_fd, POLLOUT, 0}, {m_wakeFd, POLLIN, 0}};
+        poll(pfds, stopping ? 1 : 2, int(std::max<int64_t>(0, timeout.count())));
+        return;
+    }
+
+    until = std::min(until, m_reconnectAt);
+    if (stopping) {
+        std::this_thread::sleep_until(until);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wakeWorker.wait_until(lock, until, [&]() {
+        return m_stop;
+    });
+}
+
+void UnixSocketAppender::reportDrops(bool force)
+{
+    uint64_t dropped = m_dropped;
+    if (dropped == m_reportedDrops || (!force && Clock::now() < m_nextReport)) {
+        return;
+    }
+
+    log4cplus::helpers::getLogLog().warn(LOG4CPLUS_TEXT(
+        fmt::format("UnixSocketAppender: {} records to {} dropped", dropped - m_reportedDrops, m_path)));
+    m_reportedDrops = dropped;
+    m_nextReport    = Clock::now() + ReportInterval;
+}
+
+} // namespace fty
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <log4cplus/appender.h>
+#include <mutex>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+namespace fty {
+
+// =====================================================================================================================
+
+/// Appender which forwards records as datagrams to a local collector listening on a Unix datagram socket.
+///
+/// Configuration properties:
+///   Path           - path of the collector socket
+///   BatchSize      - records sent by one sendmmsg call (default 32)
+///   MaxLatency     - milliseconds a record may wait for its batch to fill (default 100)
+///   QueueSize      - records waiting to be sent (default 4096)
+///   Overflow       - what to do with a full queue: drop (default, record is counted as dropped) or block
+///   ReconnectDelay - milliseconds between connection attempts (default 1000)
+///   FlushTimeout   - milliseconds close() keeps sending the queued records to a slow collector (default 1000)
+///
+/// Sending is done by a background thread with non blocking calls. When the collector is slow (EAGAIN) or
+/// gone, records stay queued and the connection is retried, the logging thread is only affected by a full queue.
+/// Dropped records are reported as a warning of the log4cplus internal log, at most every 10 seconds.
+class UnixSocketAppender : public log4cplus::Appender
+{
+public:
+    struct Stats
+    {
+        uint64_t sent    = 0;
+        uint64_t dropped = 0;
+        uint64_t batches = 0;
+    };
+
+public:
+    UnixSocketAppender(const log4cplus::helpers::Properties& props);
+    ~UnixSocketAppender() override;
+
+    void  close() override;
+    Stats stats() const;
+
+protected:
+    void append(const log4cplus::spi::InternalLoggingEvent& event) override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Record
+    {
+        std::string       text;
+        Clock::time_point queued;
+    };
+
+    void worker();
+    bool send(std::vector<Record>& batch);
+    bool connect();
+    void disconnect();
+    void waitCollector(Clock::time_point until, bool stopping);
+    void reportDrops(bool force);
+
+private:
+    std::string               m_path;
+    size_t                    m_batchSize      = 32;
+    std::chrono::milliseconds m_maxLatency     = std::chrono::milliseconds(100);
+    size_t                    m_queueSize      = 4096;
+    bool                      m_dropOnOverflow = true;
+    std::chrono::milliseconds m_reconnectDelay = std::chrono::milliseconds(1000);
+    std::chrono::milliseconds m_flushTimeout   = std::chrono::milliseconds(1000);
+
+    // Owned by the worker thread
+    int                  m_fd = -1;
+    Clock::time_point    m_reconnectAt;
+    Clock::time_point    m_nextReport;
+    uint64_t             m_reportedDrops = 0;
+    std::vector<mmsghdr> m_msgs;
+    std::vector<iovec>   m_iovs;
+
+    int m_wakeFd = -1; // Interrupts the wait for a slow collector on close
+
+    std::deque<Record>      m_queue;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_wakeWorker;
+    std::condition_variable m_wakeWriter;
+    bool                    m_stop = false;
+    std::thread             m_thread;
+
+    std::atomic<uint64_t> m_sent    = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<uint64_t> m_batches = 0;
+};
+
+} // namespace fty
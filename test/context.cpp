@@ -0,0 +1,97 @@
+#include "../src/context-layout.h"
+#include "fty/logcontext.h"
+#include <catch2/catch.hpp>
+#include <log4cplus/initializer.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <sstream>
+#include <thread>
+
+static std::string contextString(const fty::LogContext::Fields& fields)
+{
+    std::string out;
+    for (const auto& field : fields) {
+        out += (out.empty() ? "" : " ") + fmt::format("{}", field);
+    }
+    return out;
+}
+
+TEST_CASE("Log context")
+{
+    std::string asset = "rackcontroller-0";
+
+    SECTION("Nesting")
+    {
+        CHECK(fty::LogContext::current().empty());
+        {
+            fty::LogContext ctx1{"asset", asset};
+            {
+                fty::LogContext ctx2{"job", 42};
+                fty::LogContext ctx3{"ratio", 0.5};
+                CHECK(contextString(fty::LogContext::current()) == "asset=rackcontroller-0 job=42 ratio=0.5");
+            }
+            CHECK(contextString(fty::LogContext::current()) == "asset=rackcontroller-0");
+        }
+        CHECK(fty::LogContext::current().empty());
+    }
+
+    SECTION("By reference")
+    {
+        fty::LogContext ctx{"asset", asset};
+        CHECK(std::get<std::string_view>(fty::LogContext::current().begin()->value).data() == asset.data());
+    }
+
+    SECTION("Capacity")
+    {
+        std::vector<std::unique_ptr<fty::LogContext>> ctxs;
+        for (size_t i = 0; i < fty::LogContext::Capacity + 2; ++i) {
+            ctxs.emplace_back(std::make_unique<fty::LogContext>("num", i));
+        }
+        CHECK(fty::LogContext::current().size() == fty::LogContext::Capacity);
+
+        while (!ctxs.empty()) {
+            ctxs.pop_back();
+        }
+        CHECK(fty::LogContext::current().empty());
+    }
+
+    SECTION("Snapshot")
+    {
+        fty::LogContext ctx{"asset", asset};
+        auto            snapshot = fty::LogContext::snapshot();
+
+        std::string inTask;
+        std::thread task([&]() {
+            fty::LogContext::Scope scope(snapshot);
+            fty::LogContext        job{"job", 7u};
+            inTask = contextString(fty::LogContext::current());
+        });
+        task.join();
+
+        CHECK(inTask == "asset=rackcontroller-0 job=7");
+        CHECK(contextString(fty::LogContext::current()) == "asset=rackcontroller-0");
+    }
+
+    SECTION("Layout")
+    {
+        log4cplus::Initializer init;
+        fty::ContextLayout     layout(LOG4CPLUS_TEXT("[%K] %m%n"));
+        fty::ContextLayout     plainLayout(LOG4CPLUS_TEXT("%m%%K%n"));
+
+        log4cplus::spi::InternalLoggingEvent event(
+            LOG4CPLUS_TEXT("test"), log4cplus::INFO_LOG_LEVEL, LOG4CPLUS_TEXT("Updated"), __FILE__, __LINE__);
+
+        std::ostringstream empty;
+        layout.formatAndAppend(empty, event);
+        CHECK(empty.str() == "[] Updated\n");
+
+        fty::LogContext    ctx{"asset", asset};
+        fty::LogContext    job{"job", 42};
+        std::ostringstream out;
+        layout.formatAndAppend(out, event);
+        CHECK(out.str() == "[asset=rackcontroller-0 job=42] Updated\n");
+
+        std::ostringstream escaped;
+        plainLayout.formatAndAppend(escaped, event);
+        CHECK(escaped.str() == "Updated%K\n");
+    }
+}
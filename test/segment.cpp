@@ -0,0 +1,227 @@
+#include "../src/compressed-appender.h"
+#include "fty/logsegment.h"
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/initializer.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+static const char* SegmentFile = "/tmp/fty-logger-test.seg";
+
+static log4cplus::helpers::Properties properties(const std::map<std::string, std::string>& opts)
+{
+    log4cplus::helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("File"), SegmentFile);
+    props.setProperty(LOG4CPLUS_TEXT("layout"), LOG4CPLUS_TEXT("log4cplus::PatternLayout"));
+    props.setProperty(LOG4CPLUS_TEXT("layout.ConversionPattern"), LOG4CPLUS_TEXT("%m"));
+    for (const auto& [key, value] : opts) {
+        props.setProperty(key, value);
+    }
+    return props;
+}
+
+static void append(fty::CompressedAppender& appender, int num, time_t time)
+{
+    log4cplus::spi::InternalLoggingEvent event(LOG4CPLUS_TEXT("test"),
+        num == 5 ? log4cplus::ERROR_LOG_LEVEL : log4cplus::INFO_LOG_LEVEL, {}, {}, fmt::format("record {}", num), {},
+        {}, std::chrono::system_clock::from_time_t(time), __FILE__, __LINE__);
+    appender.doAppend(event);
+}
+
+static void writeRecords(const std::string& codec, int from, int count)
+{
+    // Block per record
+    fty::CompressedAppender appender(properties({{"Compression", codec}, {"BlockSize", "1"}}));
+    for (int i = from; i < from + count; ++i) {
+        append(appender, i, 1000 + i);
+    }
+    appender.close();
+}
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream file(path);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+static std::vector<std::string> query(const fty::LogSegment& segment, const fty::LogSegment::Query& query,
+    size_t& inflated)
+{
+    std::vector<std::string> out;
+    auto                     res = segment.query(query, [&](const fty::LogSegment::Record& rec) {
+        out.emplace_back(rec.text);
+    });
+    REQUIRE(res);
+    inflated = *res;
+    return out;
+}
+
+TEST_CASE("Compressed segment")
+{
+    log4cplus::Initializer init;
+    remove(SegmentFile);
+
+    auto codec = GENERATE(std::string("lz4"), std::string("zstd"));
+    writeRecords(codec, 0, 10);
+
+    auto segment = fty::LogSegment::open(SegmentFile);
+    REQUIRE(segment);
+    CHECK(segment->blocksCount() == 10);
+
+    size_t inflated = 0;
+
+    SECTION("Whole segment")
+    {
+        auto recs = query(*segment, {}, inflated);
+        REQUIRE(recs.size() == 10);
+        CHECK(recs.front() == "record 0");
+        CHECK(recs.back() == "record 9");
+        CHECK(inflated == 10);
+    }
+
+    SECTION("Time window")
+    {
+        fty::LogSegment::Query q;
+        q.from = std::chrono::system_clock::from_time_t(1002);
+        q.to   = std::chrono::system_clock::from_time_t(1004);
+
+        auto recs = query(*segment, q, inflated);
+        CHECK(recs == std::vector<std::string>{"record 2", "record 3", "record 4"});
+        CHECK(inflated == 3);
+    }
+
+    SECTION("Minimum level")
+    {
+        fty::LogSegment::Query q;
+        q.minLevel = fty::Logger::Level::Error;
+
+        auto recs = query(*segment, q, inflated);
+        CHECK(recs == std::vector<std::string>{"record 5"});
+        CHECK(inflated == 1);
+    }
+
+    SECTION("Continue existing segment")
+    {
+        writeRecords(codec, 10, 2);
+
+        auto cont = fty::LogSegment::open(SegmentFile);
+        REQUIRE(cont);
+        CHECK(cont->blocksCount() == 12);
+        CHECK(query(*cont, {}, inflated).back() == "record 11");
+    }
+
+    remove(SegmentFile);
+}
+
+TEST_CASE("Compressed segment, records out of time order")
+{
+    log4cplus::Initializer init;
+    remove(SegmentFile);
+
+    // Records of several threads reach the appender in any order, all of them land in one block
+    {
+        fty::CompressedAppender appender(properties({}));
+        append(appender, 0, 1000);
+        append(appender, 1, 1010);
+        append(appender, 2, 1005);
+        appender.close();
+    }
+
+    auto segment = fty::LogSegment::open(SegmentFile);
+    REQUIRE(segment);
+    REQUIRE(segment->blocksCount() == 1);
+
+    fty::LogSegment::Query q;
+    q.from = std::chrono::system_clock::from_time_t(1008);
+    q.to   = std::chrono::system_clock::from_time_t(1012);
+
+    size_t inflated = 0;
+    CHECK(query(*segment, q, inflated) == std::vector<std::string>{"record 1"});
+
+    remove(SegmentFile);
+}
+
+TEST_CASE("Compressed segment, existing file is not a segment")
+{
+    log4cplus::Initializer init;
+    {
+        std::ofstream file(SegmentFile, std::ios::trunc);
+        file << "Old plain text log\n";
+    }
+
+    {
+        fty::CompressedAppender appender(properties({}));
+        append(appender, 0, 1000);
+        appender.close();
+    }
+
+    CHECK(readFile(SegmentFile) == "Old plain text log\n");
+    CHECK(!fty::LogSegment::open(SegmentFile));
+
+    remove(SegmentFile);
+}
+
+TEST_CASE("Compressed segment, flush interval")
+{
+    log4cplus::Initializer init;
+    remove(SegmentFile);
+
+    fty::CompressedAppender appender(properties({{"FlushInterval", "20"}}));
+    append(appender, 0, 1000);
+
+    // Live segment, the partial block has to show up without closing the appender
+    size_t found = 0;
+    for (int i = 0; i < 200 && !found; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (auto segment = fty::LogSegment::open(SegmentFile)) {
+            size_t inflated = 0;
+            found           = query(*segment, {}, inflated).size();
+        }
+    }
+    CHECK(found == 1);
+
+    appender.close();
+    remove(SegmentFile);
+}
+
+TEST_CASE("Compressed segment, rotation")
+{
+    log4cplus::Initializer init;
+    auto backup = [](int num) {
+        return fmt::format("{}.{}", SegmentFile, num);
+    };
+    remove(SegmentFile);
+    for (int i = 1; i <= 3; ++i) {
+        remove(backup(i).c_str());
+    }
+
+    {
+        // Every block fills the segment
+        fty::CompressedAppender appender(
+            properties({{"BlockSize", "1"}, {"MaxFileSize", "1"}, {"MaxBackupIndex", "2"}}));
+        for (int i = 0; i < 5; ++i) {
+            append(appender, i, 1000 + i);
+        }
+        appender.close();
+    }
+
+    auto records = [](const std::string& path) {
+        auto segment = fty::LogSegment::open(path);
+        REQUIRE(segment);
+        size_t inflated = 0;
+        return query(*segment, {}, inflated);
+    };
+
+    CHECK(records(SegmentFile).empty());
+    CHECK(records(backup(1)) == std::vector<std::string>{"record 4"});
+    CHECK(records(backup(2)) == std::vector<std::string>{"record 3"});
+    CHECK(access(backup(3).c_str(), F_OK) != 0);
+
+    remove(SegmentFile);
+    for (int i = 1; i <= 2; ++i) {
+        remove(backup(i).c_str());
+    }
+}
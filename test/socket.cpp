@@ -0,0 +1,312 @@
+#include "../src/socket-appender.h"
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <fmt/format.h>
+#include <log4cplus/helpers/property.h>
+#include <log4cplus/initializer.h>
+#include <log4cplus/spi/loggingevent.h>
+#include <map>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char* CollectorPath = "/tmp/fty-logger-test.sock";
+
+static const std::string Filler = "filler";
+
+// Stand-in for the local collector, reading from its own thread. A busy collector is simulated by staying idle until
+// start(), with its receive queue filled first, so the appender hits EAGAIN regardless of net.unix.max_dgram_qlen.
+class Collector
+{
+public:
+    Collector(bool reading = true)
+    {
+        unlink(CollectorPath);
+        m_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+        sockaddr_un addr = {};
+        addr.sun_family  = AF_UNIX;
+        strncpy(addr.sun_path, CollectorPath, sizeof(addr.sun_path) - 1);
+        REQUIRE(bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+        timeval tv = {0, 50000};
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        if (reading) {
+            start();
+        }
+    }
+
+    ~Collector()
+    {
+        m_running = false;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        for (int fd : m_probes) {
+            close(fd);
+        }
+        close(m_fd);
+        unlink(CollectorPath);
+    }
+
+    /// Fills the receive queue with filler datagrams until it is full
+    void fill()
+    {
+        sockaddr_un addr = {};
+        addr.sun_family  = AF_UNIX;
+        strncpy(addr.sun_path, CollectorPath, sizeof(addr.sun_path) - 1);
+
+        // A sender may run out of its own send buffer first, the queue is full once a fresh sender cannot add anything
+        while (true) {
+            int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            REQUIRE(fd >= 0);
+            m_probes.push_back(fd);
+            REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+            size_t sent = 0;
+            while (::send(fd, Filler.data(), Filler.size(), MSG_NOSIGNAL) >= 0) {
+                ++sent;
+            }
+            REQUIRE(errno == EAGAIN);
+            if (!sent) {
+                return;
+            }
+        }
+    }
+
+    void start()
+    {
+        m_running = true;
+        m_thread  = std::thread([this]() {
+            char buf[1024];
+            while (m_running) {
+                ssize_t size = recv(m_fd, buf, sizeof(buf), 0);
+                if (size >= 0 && std::string_view(buf, size_t(size)) != Filler) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_received.emplace_back(buf, size_t(size));
+                    m_cond.notify_all();
+                }
+            }
+        });
+    }
+
+    /// Records received so far, waits a bit for at least `count` of them
+    std::vector<std::string> received(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait_for(lock, std::chrono::seconds(2), [&]() {
+            return m_received.size() >= count;
+        });
+        return m_received;
+    }
+
+private:
+    int                      m_fd = -1;
+    std::vector<int>         m_probes;
+    std::atomic<bool>        m_running{false};
+    std::thread              m_thread;
+    std::mutex               m_mutex;
+    std::condition_variable  m_cond;
+    std::vector<std::string> m_received;
+};
+
+static std::unique_ptr<fty::UnixSocketAppender> appender(const std::map<std::string, std::string>& opts)
+{
+    log4cplus::helpers::Properties props;
+    props.setProperty(LOG4CPLUS_TEXT("Path"), CollectorPath);
+    props.setProperty(LOG4CPLUS_TEXT("layout"), LOG4CPLUS_TEXT("log4cplus::PatternLayout"));
+    props.setProperty(LOG4CPLUS_TEXT("layout.ConversionPattern"), LOG4CPLUS_TEXT("%m"));
+    for (const auto& [key, value] : opts) {
+        props.setProperty(key, value);
+    }
+    return std::make_unique<fty::UnixSocketAppender>(props);
+}
+
+static void log(fty::UnixSocketAppender& app, int num)
+{
+    log4cplus::spi::InternalLoggingEvent event(
+        LOG4CPLUS_TEXT("test"), log4cplus::INFO_LOG_LEVEL, fmt::format("record {}", num), __FILE__, __LINE__);
+    app.doAppend(event);
+}
+
+static std::vector<std::string> records(int from, int count)
+{
+    std::vector<std::string> out;
+    for (int i = from; i < from + count; ++i) {
+        out.push_back(fmt::format("record {}", i));
+    }
+    return out;
+}
+
+static bool inOrder(const std::vector<std::string>& recs)
+{
+    int last = -1;
+    for (const auto& rec : recs) {
+        int num = std::stoi(rec.substr(strlen("record ")));
+        if (num <= last) {
+            return false;
+        }
+        last = num;
+    }
+    return true;
+}
+
+TEST_CASE("Unix socket appender")
+{
+    log4cplus::Initializer init;
+
+    SECTION("Ordering and batching")
+    {
+        Collector collector;
+        auto      app = appender({{"BatchSize", "10"}, {"MaxLatency", "5000"}});
+        for (int i = 0; i < 25; ++i) {
+            log(*app, i);
+        }
+        app->close();
+
+        CHECK(collector.received(25) == records(0, 25));
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 25);
+        CHECK(stats.dropped == 0);
+        // At most 10 records per call, a batch may be split if the collector is momentarily full
+        CHECK(stats.batches >= 3);
+        CHECK(stats.batches < stats.sent);
+    }
+
+    SECTION("Latency")
+    {
+        Collector collector;
+        auto      app = appender({{"BatchSize", "100"}, {"MaxLatency", "50"}});
+        log(*app, 1);
+
+        // Batch is far from full, record is sent anyway once it waited long enough
+        CHECK(collector.received(1) == records(1, 1));
+
+        app->close();
+        CHECK(app->stats().batches == 1);
+    }
+
+    SECTION("Loss accounting")
+    {
+        unlink(CollectorPath);
+        auto app = appender({{"BatchSize", "4"}, {"QueueSize", "8"}, {"MaxLatency", "10"}, {"FlushTimeout", "50"}});
+        for (int i = 0; i < 50; ++i) {
+            log(*app, i);
+        }
+        app->close();
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 0);
+        CHECK(stats.dropped == 50);
+    }
+
+    SECTION("Reconnect")
+    {
+        unlink(CollectorPath);
+        auto app = appender({{"MaxLatency", "10"}, {"ReconnectDelay", "50"}});
+        log(*app, 1);
+
+        Collector collector;
+        CHECK(collector.received(1) == records(1, 1));
+        app->close();
+        CHECK(app->stats().dropped == 0);
+    }
+
+    SECTION("Busy collector, drop")
+    {
+        Collector collector(false);
+        collector.fill();
+
+        auto app = appender({{"BatchSize", "4"}, {"QueueSize", "8"}, {"MaxLatency", "10"}});
+        for (int i = 0; i < 100; ++i) {
+            log(*app, i);
+        }
+
+        // Collector does not take anything (EAGAIN), only the queue and the batch in flight are kept
+        uint64_t dropped = app->stats().dropped;
+        CHECK(dropped >= 100 - 8 - 4);
+        CHECK(dropped < 100);
+
+        collector.start();
+        auto recs = collector.received(100 - dropped);
+        app->close();
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 100 - dropped);
+        CHECK(stats.dropped == dropped);
+        CHECK(recs.size() == stats.sent);
+        CHECK(inOrder(recs));
+    }
+
+    SECTION("Busy collector, close")
+    {
+        Collector collector(false);
+        collector.fill();
+
+        auto app = appender({{"BatchSize", "4"}, {"QueueSize", "8"}, {"MaxLatency", "10"}, {"FlushTimeout", "100"}});
+        for (int i = 0; i < 10; ++i) {
+            log(*app, i);
+        }
+
+        // Collector stays busy, close must give up after FlushTimeout
+        auto started = std::chrono::steady_clock::now();
+        app->close();
+        CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(2));
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 0);
+        CHECK(stats.dropped == 10);
+    }
+
+    SECTION("Busy collector, block")
+    {
+        Collector collector(false);
+        collector.fill();
+
+        auto app = appender({{"BatchSize", "2"}, {"QueueSize", "4"}, {"MaxLatency", "10"}, {"Overflow", "block"}});
+
+        std::atomic<bool> done{false};
+        std::thread       producer([&]() {
+            for (int i = 0; i < 40; ++i) {
+                log(*app, i);
+            }
+            done = true;
+        });
+
+        // Collector does not take anything, the producer has to wait once the queue and the batch in flight are full
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        CHECK(!done);
+
+        collector.start();
+        producer.join();
+        app->close();
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 40);
+        CHECK(stats.dropped == 0);
+        CHECK(collector.received(40) == records(0, 40));
+    }
+
+    SECTION("Blocked writer does not prevent close")
+    {
+        unlink(CollectorPath);
+        auto app = appender(
+            {{"BatchSize", "1"}, {"QueueSize", "2"}, {"MaxLatency", "10"}, {"Overflow", "block"}, {"FlushTimeout", "50"}});
+
+        std::thread producer([&]() {
+            for (int i = 0; i < 10; ++i) {
+                log(*app, i);
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        app->close();
+        producer.join();
+
+        auto stats = app->stats();
+        CHECK(stats.sent == 0);
+        CHECK(stats.dropped > 0);
+    }
+}
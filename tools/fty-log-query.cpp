@@ -0,0 +1,106 @@
+#include "fty/logsegment.h"
+#include <ctime>
+#include <getopt.h>
+#include <iostream>
+#include <optional>
+
+// Prints records of compressed log segments matching a time window and a minimum level, e.g.
+//   fty-log-query -f "2021-03-01 10:00:00" -t "2021-03-01 11:00:00" -l warn /var/log/fty/agent.seg
+
+static std::optional<fty::LogSegment::TimePoint> timeFromString(const std::string& str)
+{
+    struct tm tm = {};
+    if (const char* end = strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &tm); end && *end == '\0') {
+        tm.tm_isdst = -1;
+        return std::chrono::system_clock::from_time_t(mktime(&tm));
+    }
+
+    // Seconds since epoch
+    char* end  = nullptr;
+    auto  secs = std::strtoll(str.c_str(), &end, 10);
+    if (end != str.c_str() && *end == '\0') {
+        return std::chrono::system_clock::from_time_t(time_t(secs));
+    }
+    return std::nullopt;
+}
+
+static std::optional<fty::Logger::Level> levelFromString(const std::string& level)
+{
+    if (level == "trace") {
+        return fty::Logger::Level::Trace;
+    } else if (level == "debug") {
+        return fty::Logger::Level::Debug;
+    } else if (level == "info") {
+        return fty::Logger::Level::Info;
+    } else if (level == "warn") {
+        return fty::Logger::Level::Warn;
+    } else if (level == "error") {
+        return fty::Logger::Level::Error;
+    } else if (level == "fatal") {
+        return fty::Logger::Level::Fatal;
+    }
+    return std::nullopt;
+}
+
+static void usage(const char* name)
+{
+    std::cerr << "Usage: " << name << " [-f from] [-t to] [-l trace|debug|info|warn|error|fatal] segment...\n"
+              << "  Time is 'YYYY-MM-DD HH:MM:SS' in local time or seconds since epoch\n";
+}
+
+int main(int argc, char** argv)
+{
+    fty::LogSegment::Query query;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:l:h")) != -1) {
+        switch (opt) {
+        case 'f':
+        case 't': {
+            auto time = timeFromString(optarg);
+            if (!time) {
+                std::cerr << "Invalid time: " << optarg << "\n";
+                return EXIT_FAILURE;
+            }
+            (opt == 'f' ? query.from : query.to) = *time;
+            break;
+        }
+        case 'l': {
+            auto level = levelFromString(optarg);
+            if (!level) {
+                std::cerr << "Invalid level: " << optarg << "\n";
+                return EXIT_FAILURE;
+            }
+            query.minLevel = *level;
+            break;
+        }
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int ret = EXIT_SUCCESS;
+    for (int i = optind; i < argc; ++i) {
+        auto segment = fty::LogSegment::open(argv[i]);
+        if (!segment) {
+            std::cerr << segment.error() << "\n";
+            ret = EXIT_FAILURE;
+            continue;
+        }
+
+        auto res = segment->query(query, [](const fty::LogSegment::Record& rec) {
+            std::cout << rec.text;
+        });
+        if (!res) {
+            std::cerr << argv[i] << ": " << res.error() << "\n";
+            ret = EXIT_FAILURE;
+        }
+    }
+    return ret;
+}